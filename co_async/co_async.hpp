@@ -68,6 +68,7 @@
 #include <co_async/utils/spin_mutex.hpp>
 #include <co_async/utils/string_utils.hpp>
 #include <co_async/utils/uninitialized.hpp>
+#include <co_async/utils/work_stealing_deque.hpp>
 #include <co_async/net/websocket.hpp>
 #include <co_async/utils/byteorder.hpp>
 #include <co_async/utils/random.hpp>
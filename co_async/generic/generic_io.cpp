@@ -3,14 +3,14 @@
 
 namespace co_async {
 
-// bool GenericIOContext::runComputeOnly() {
-//     if (auto coroutine = mQueue.pop()) {
-//         coroutine->resume();
-//         return true;
-//     }
-//     return false;
-// }
-//
+bool GenericIOContext::runComputeOnly() {
+    if (auto coroutine = popJob()) {
+        coroutine->resume();
+        return true;
+    }
+    return false;
+}
+
 GenericIOContext::GenericIOContext() = default;
 GenericIOContext::~GenericIOContext() = default;
 
@@ -11,6 +11,7 @@
 #include <co_async/utils/ring_queue.hpp>
 #include <co_async/utils/spin_mutex.hpp>
 #include <co_async/utils/uninitialized.hpp>
+#include <co_async/utils/work_stealing_deque.hpp>
 
 namespace co_async {
 struct IOContext;
@@ -56,9 +57,46 @@ struct GenericIOContext {
     [[gnu::hot]] std::optional<std::chrono::steady_clock::duration>
     runDuration();
 
-    // [[gnu::hot]] void enqueueJob(std::coroutine_handle<> coroutine) {
-    //     mQueue.push(std::move(coroutine));
-    // }
+    [[gnu::hot]] bool runComputeOnly();
+
+    [[gnu::hot]] void enqueueJobMT(std::coroutine_handle<> coroutine) {
+        mQueue.push(std::move(coroutine));
+    }
+
+    // unlike enqueueJobMT, never taken away by other workers
+    [[gnu::hot]] void enqueuePinnedJobMT(std::coroutine_handle<> coroutine) {
+#if CO_ASYNC_STEAL
+        mPinnedQueue.push(std::move(coroutine));
+#else
+        mQueue.push(std::move(coroutine));
+#endif
+    }
+
+    [[gnu::hot]] std::optional<std::coroutine_handle<>> popJob() {
+#if CO_ASYNC_STEAL
+        if (auto coroutine = mReady.pop()) {
+            return coroutine;
+        }
+        if (auto coroutine = mPinnedQueue.pop()) {
+            return coroutine;
+        }
+#endif
+        return mQueue.pop();
+    }
+
+#if CO_ASYNC_STEAL
+    // must be called from the thread owning this context
+    [[gnu::hot]] void enqueueJob(std::coroutine_handle<> coroutine) {
+        mReady.push(coroutine);
+    }
+
+    /* MT-safe */ std::optional<std::coroutine_handle<>> stealJob() {
+        if (auto coroutine = mReady.steal()) {
+            return coroutine;
+        }
+        return mQueue.pop();
+    }
+#endif
 
     [[gnu::hot]] void enqueueTimerNode(TimerNode &promise) {
         mTimers.insert(promise);
@@ -72,6 +110,11 @@ struct GenericIOContext {
 
 private:
     RbTree<TimerNode> mTimers;
+    ConcurrentRingQueue<std::coroutine_handle<>> mQueue;
+#if CO_ASYNC_STEAL
+    WorkStealingDeque<std::coroutine_handle<>> mReady;
+    ConcurrentRingQueue<std::coroutine_handle<>> mPinnedQueue;
+#endif
 };
 
 inline void GenericIOContext::TimerNode::Awaiter::await_suspend(
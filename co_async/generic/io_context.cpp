@@ -2,9 +2,12 @@
 #include <co_async/awaiter/task.hpp>
 #include <co_async/generic/generic_io.hpp>
 #include <co_async/generic/io_context.hpp>
-#include <co_async/platform/futex.hpp>
+#include <co_async/generic/io_context_mt.hpp>
+#include <co_async/platform/error_handling.hpp>
 #include <co_async/platform/platform_io.hpp>
 #include <co_async/utils/cacheline.hpp>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace co_async {
 
@@ -18,21 +21,137 @@ IOContext::IOContext(IOContextOptions options) {
     if (options.threadAffinity) {
         PlatformIOContext::schedSetThreadAffinity(*options.threadAffinity);
     }
-    mPlatformIO.setup(options.queueEntries);
+    mPlatformIO.setup(options.queueEntries, options.uring);
+    mPlatformIO.setSubmitBatch(options.submitBatch);
+    mWakeFd = throwingErrorErrno(eventfd(0, EFD_CLOEXEC));
     mMaxSleep = options.maxSleep;
 }
 
 IOContext::~IOContext() {
+    // jobs spawned but never got a chance to run
+    mPlatformIO.destroyPendingMessages();
+    while (auto coroutine = mGenericIO.popJob()) {
+        coroutine->destroy();
+    }
+    if (mWakeFd != -1) {
+        close(mWakeFd);
+    }
     IOContext::instance = nullptr;
     GenericIOContext::instance = nullptr;
     PlatformIOContext::instance = nullptr;
 }
 
 void IOContext::run() {
-    while (runOnce())
-        ;
+    do {
+        while (mGenericIO.runComputeOnly())
+            ;
+    } while (runOnce());
+}
+
+void IOContext::run(std::stop_token stop) {
+    std::stop_callback _(stop, [this] { wakeUp(); });
+    auto watchDog = watchDogTask();
+    watchDog.get().resume();
+    while (!stop.stop_requested()) [[likely]] {
+        while (!stop.stop_requested() && mGenericIO.runComputeOnly())
+            ;
+#if CO_ASYNC_STEAL
+        // announce idle before the last check, so that whoever pushes a job
+        // after it is guaranteed to see us idle and wake us up
+        mIdle.store(true, std::memory_order_seq_cst);
+        auto coroutine = mGenericIO.popJob();
+        if (!coroutine) {
+            coroutine = stealJob();
+        }
+        if (coroutine) {
+            mIdle.store(false, std::memory_order_relaxed);
+            coroutine->resume();
+            continue;
+        }
+#endif
+        runOnce();
+    }
+}
+
+void IOContext::spawn(std::coroutine_handle<> coroutine) {
+#if CO_ASYNC_STEAL
+    // keep it in our queues so that it can be stolen
+    if (instance == this) {
+        mGenericIO.enqueueJob(coroutine);
+    } else {
+        mGenericIO.enqueueJobMT(coroutine);
+    }
+    wakeUpIdle();
+#else
+    post(coroutine);
+#endif
 }
 
+void IOContext::post(std::coroutine_handle<> coroutine) {
+    if (instance == this) {
+        mGenericIO.enqueuePinnedJobMT(coroutine);
+        return;
+    }
+    // hand over as a CQE on the target ring, one syscall and no sleeping
+    if (PlatformIOContext::instance &&
+        PlatformIOContext::instance->postMessage(
+            mPlatformIO, reinterpret_cast<std::uint64_t>(coroutine.address())))
+        [[likely]] {
+        return;
+    }
+    mGenericIO.enqueuePinnedJobMT(coroutine);
+    wakeUp();
+}
+
+#if CO_ASYNC_STEAL
+std::optional<std::coroutine_handle<>> IOContext::stealJob() {
+    if (!IOContextMT::instance) {
+        return std::nullopt;
+    }
+    std::size_t n = IOContextMT::num_workers();
+    std::size_t self = mWorkerId;
+    for (std::size_t i = 1; i < n; ++i) {
+        auto &victim = IOContextMT::nth_worker((self + i) % n);
+        if (auto coroutine = victim.mGenericIO.stealJob()) {
+            return coroutine;
+        }
+    }
+    return std::nullopt;
+}
+
+void IOContext::wakeUpIdle() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto claimIdle = [](IOContext &worker) {
+        return worker.mIdle.load(std::memory_order_relaxed) &&
+               worker.mIdle.exchange(false, std::memory_order_acq_rel);
+    };
+    // prefer the owner of the job, then anyone idle that may steal it, we
+    // ourselves are obviously awake and would find the job anyway
+    IOContext *target = nullptr;
+    if (this != instance && claimIdle(*this)) {
+        target = this;
+    } else if (IOContextMT::instance) {
+        std::size_t n = IOContextMT::num_workers();
+        std::size_t self = instance ? instance->mWorkerId : 0;
+        for (std::size_t i = 1; i <= n; ++i) {
+            auto &worker = IOContextMT::nth_worker((self + i) % n);
+            if (&worker != instance && claimIdle(worker)) {
+                target = &worker;
+                break;
+            }
+        }
+    }
+    if (!target) {
+        return;
+    }
+    if (!PlatformIOContext::instance ||
+        !PlatformIOContext::instance->postMessage(target->mPlatformIO))
+        [[unlikely]] {
+        target->wakeUp();
+    }
+}
+#endif
+
 bool IOContext::runOnce() {
     auto duration = mGenericIO.runDuration();
     if (!duration && !mPlatformIO.hasPendingEvents()) [[unlikely]] {
@@ -41,25 +160,38 @@ bool IOContext::runOnce() {
     if (!duration || *duration > mMaxSleep) {
         duration = mMaxSleep;
     }
-    mPlatformIO.waitEventsFor(duration);
+    bool hasEvents = mPlatformIO.waitEvents(duration);
+#if CO_ASYNC_STEAL
+    // completions may be heavy work, do not look idle while running them
+    mIdle.store(false, std::memory_order_relaxed);
+#endif
+    if (hasEvents) {
+        mPlatformIO.dispatchEvents();
+    }
     return true;
 }
 
 thread_local IOContext *IOContext::instance;
 
-// void IOContext::wakeUp() {
-//     if (mWake.fetch_add(1, std::memory_order_relaxed) == 0)
-//         futex_notify_sync(&mWake, 1);
-// }
-//
-// Task<void, IgnoreReturnPromise<AutoDestroyFinalAwaiter>>
-// IOContext::watchDogTask() {
-//     // helps wake up main loop when IOContext::spawn called
-//     while (true) {
-//         while (mWake.load(std::memory_order_relaxed) == 0)
-//             (void)co_await futex_wait(&mWake, 0);
-//         mWake.store(0, std::memory_order_relaxed);
-//     }
-// }
+void IOContext::wakeUp() {
+    if (mWake.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        std::uint64_t one = 1;
+        (void)!write(mWakeFd, &one, sizeof(one));
+    }
+}
+
+Task<void, IgnoreReturnPromise<>> IOContext::watchDogTask() {
+    // helps wake up main loop when IOContext::spawn called from a thread
+    // without a ring, or kernel too old for IORING_OP_MSG_RING
+    std::uint64_t counter;
+    while (true) {
+        (void)co_await UringOp().prep_read(
+            mWakeFd,
+            std::span<char>(reinterpret_cast<char *>(&counter),
+                            sizeof(counter)),
+            0);
+        mWake.exchange(0, std::memory_order_acq_rel);
+    }
+}
 
 } // namespace co_async
@@ -1,5 +1,6 @@
 #pragma once
 #include <co_async/std.hpp>
+#include <co_async/awaiter/details/ignore_return_promise.hpp>
 #include <co_async/awaiter/task.hpp>
 #include <co_async/generic/generic_io.hpp>
 #include <co_async/platform/platform_io.hpp>
@@ -11,6 +12,10 @@ struct IOContextOptions {
         std::chrono::milliseconds(200);
     std::optional<std::size_t> threadAffinity = std::nullopt;
     std::size_t queueEntries = 512;
+    // defer io_uring_enter until this many SQEs queued, as long as there are
+    // completions left to handle, 0 to submit every loop turn
+    std::size_t submitBatch = 0;
+    IOUringOptions uring = {};
 };
 
 struct alignas(hardware_destructive_interference_size) IOContext {
@@ -18,6 +23,19 @@ private:
     GenericIOContext mGenericIO;
     PlatformIOContext mPlatformIO;
     std::chrono::steady_clock::duration mMaxSleep;
+    std::atomic<std::uint32_t> mWake{0};
+    int mWakeFd = -1;
+    std::size_t mWorkerId = 0;
+#if CO_ASYNC_STEAL
+    std::atomic<bool> mIdle{false};
+
+    std::optional<std::coroutine_handle<>> stealJob();
+    void wakeUpIdle();
+#endif
+
+    Task<void, IgnoreReturnPromise<>> watchDogTask();
+
+    friend struct IOContextMT;
 
 public:
     explicit IOContext(IOContextOptions options = {});
@@ -27,21 +45,20 @@ public:
     [[gnu::hot]] void run();
     [[gnu::hot]] bool runOnce();
 
-    // [[gnu::hot]] void spawn(std::coroutine_handle<> coroutine) {
-    //     coroutine.resume();
-    // }
-    //
-    // template <class T, class P>
-    // void spawn(Task<T, P> task) {
-    //     auto wrapped = coSpawnStarter(std::move(task));
-    //     wrapped.get().resume();
-    //     wrapped.release();
-    // }
-    //
-    // template <class T, class P>
-    // T join(Task<T, P> task) {
-    //     return contextJoin(*this, std::move(task));
-    // }
+    // keeps running until stop requested, accepting jobs from other threads
+    [[gnu::hot]] void run(std::stop_token stop);
+
+    /* MT-safe */ void wakeUp();
+
+    /* MT-safe */ [[gnu::hot]] void spawn(std::coroutine_handle<> coroutine);
+    // like spawn, but guaranteed to be resumed by this context
+    /* MT-safe */ [[gnu::hot]] void post(std::coroutine_handle<> coroutine);
+
+    template <Awaitable A>
+    /* MT-safe */ void spawn(A awaitable) {
+        auto wrapped = coSpawnStarter(std::move(awaitable));
+        spawn(static_cast<std::coroutine_handle<>>(wrapped.release()));
+    }
 
     static thread_local IOContext *instance;
 };
@@ -115,22 +132,22 @@ inline void co_main(Task<> main) {
 //         return result.move();
 //     }
 // }
-//
-// inline auto co_resume_on(IOContext &context) {
-//     struct ResumeOnAwaiter {
-//         bool await_ready() const noexcept {
-//             return false;
-//         }
-//
-//         void await_suspend(std::coroutine_handle<> coroutine) const {
-//             mContext.spawn(coroutine);
-//         }
-//
-//         void await_resume() const noexcept {}
-//
-//         IOContext &mContext;
-//     };
-//
-//     return ResumeOnAwaiter(context);
-// }
+
+inline auto co_resume_on(IOContext &context) {
+    struct ResumeOnAwaiter {
+        bool await_ready() const noexcept {
+            return &mContext == IOContext::instance;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) const {
+            mContext.post(coroutine);
+        }
+
+        void await_resume() const noexcept {}
+
+        IOContext &mContext;
+    };
+
+    return ResumeOnAwaiter(context);
+}
 } // namespace co_async
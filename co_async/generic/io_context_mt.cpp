@@ -14,24 +14,117 @@ IOContextMT::IOContextMT() {
 }
 
 IOContextMT::~IOContextMT() {
+    stop();
+    joinThreads();
     IOContextMT::instance = nullptr;
 }
 
-void IOContextMT::run(std::size_t numWorkers) {
-    // if (numWorkers == 0) {
-    //     setAffinity = true;
-    //     numWorkers = std::thread::hardware_concurrency();
-    //     if (!numWorkers) [[unlikely]] {
-    //         throw std::logic_error(
-    //             "failed to detect number of hardware threads");
-    //     }
-    // } else {
-    //     setAffinity = false;
-    // }
-    instance->mWorkers = std::make_unique<IOContext[]>(numWorkers);
+void IOContextMT::start(std::size_t numWorkers, IOContextOptions options) {
+    if (!instance) [[unlikely]] {
+        throw std::logic_error("IOContextMT must be constructed before start");
+    }
+    if (instance->mWorkers) [[unlikely]] {
+        throw std::logic_error("IOContextMT already started");
+    }
+    std::size_t numCpus = std::thread::hardware_concurrency();
+    if (numWorkers == 0) {
+        numWorkers = numCpus;
+        if (!numWorkers) [[unlikely]] {
+            throw std::logic_error(
+                "failed to detect number of hardware threads");
+        }
+    }
+    instance->mWorkers = std::make_unique<Worker[]>(numWorkers);
     instance->mNumWorkers = numWorkers;
+    instance->mNumRunning.store(numWorkers, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < numWorkers; ++i) {
+        auto &worker = instance->mWorkers[i];
+        auto workerOptions = options;
+        if (numCpus) [[likely]] {
+            workerOptions.threadAffinity = i % numCpus;
+        }
+        worker.mThread = std::jthread([&worker, i, workerOptions = std::move(
+                                                       workerOptions)](
+                                          std::stop_token stop) {
+            std::optional<IOContext> context;
+            try {
+                context.emplace(workerOptions);
+                context->mWorkerId = i;
+            } catch (...) {
+                worker.mException = std::current_exception();
+            }
+            worker.mContext = context ? &*context : nullptr;
+            worker.mReady.store(true, std::memory_order_release);
+            worker.mReady.notify_one();
+            // other workers may be visited (e.g. stolen from) once we run
+            instance->mStarted.wait(false, std::memory_order_acquire);
+            if (context) [[likely]] {
+                try {
+                    context->run(stop);
+                } catch (...) {
+                    worker.mException = std::current_exception();
+                    IOContextMT::stop();
+                }
+            }
+            // jobs on other workers may still spawn to us, wait until all of
+            // them left their loops before any context get destroyed
+            auto &running = instance->mNumRunning;
+            if (running.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                running.notify_all();
+            } else {
+                while (auto n = running.load(std::memory_order_acquire)) {
+                    running.wait(n, std::memory_order_acquire);
+                }
+            }
+            worker.mContext = nullptr;
+        });
+    }
+    // wait for all rings to be set up, so that spawn can be used right away
+    for (std::size_t i = 0; i < numWorkers; ++i) {
+        auto &worker = instance->mWorkers[i];
+        worker.mReady.wait(false, std::memory_order_acquire);
+    }
+    std::exception_ptr exception;
+    for (std::size_t i = 0; i < numWorkers; ++i) {
+        if (auto e = instance->mWorkers[i].mException) [[unlikely]] {
+            exception = e;
+            stop();
+            break;
+        }
+    }
+    instance->mStarted.store(true, std::memory_order_release);
+    instance->mStarted.notify_all();
+    if (exception) [[unlikely]] {
+        joinThreads();
+        instance->mWorkers.reset();
+        instance->mNumWorkers = 0;
+        instance->mStarted.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(exception);
+    }
+}
+
+void IOContextMT::stop() {
+    for (std::size_t i = 0; i < instance->mNumWorkers; ++i) {
+        instance->mWorkers[i].mThread.request_stop();
+    }
+}
+
+void IOContextMT::joinThreads() noexcept {
+    for (std::size_t i = 0; i < instance->mNumWorkers; ++i) {
+        auto &thread = instance->mWorkers[i].mThread;
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void IOContextMT::join() {
+    joinThreads();
     for (std::size_t i = 0; i < instance->mNumWorkers; ++i) {
-        instance->mWorkers[i].run();
+        if (auto e = std::exchange(instance->mWorkers[i].mException, nullptr))
+            [[unlikely]] {
+            std::rethrow_exception(e);
+        }
     }
 }
 
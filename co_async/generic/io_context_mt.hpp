@@ -8,41 +8,66 @@
 namespace co_async {
 struct IOContextMT {
 private:
-    std::unique_ptr<IOContext[]> mWorkers;
+    struct alignas(hardware_destructive_interference_size) Worker {
+        IOContext *mContext = nullptr;
+        std::exception_ptr mException;
+        std::atomic<bool> mReady{false};
+        std::jthread mThread;
+    };
+
+    std::unique_ptr<Worker[]> mWorkers;
     std::size_t mNumWorkers = 0;
+    std::atomic<std::size_t> mNumRunning{0};
+
+    static void joinThreads() noexcept;
+    std::atomic<bool> mStarted{false};
 
 public:
     IOContextMT();
-    IOContextMT(IOContext &&) = delete;
+    IOContextMT(IOContextMT &&) = delete;
     ~IOContextMT();
 
     static std::size_t get_worker_id(IOContext const &context) noexcept {
-        return static_cast<std::size_t>(&context - instance->mWorkers.get());
+        return context.mWorkerId;
     }
 
     static std::size_t this_worker_id() noexcept {
         return get_worker_id(*IOContext::instance);
     }
 
-    static IOContext &nth_worker(std::size_t index) noexcept {
-        return instance->mWorkers[index];
+    static IOContext &nth_worker(std::size_t index) {
+        if (!instance || index >= instance->mNumWorkers ||
+            !instance->mWorkers[index].mContext) [[unlikely]] {
+            throw std::logic_error("IOContextMT worker not running");
+        }
+        return *instance->mWorkers[index].mContext;
     }
 
     static std::size_t num_workers() noexcept {
         return instance->mNumWorkers;
     }
 
-    static void run(std::size_t numWorkers = 0);
-
-    // static void spawn(std::coroutine_handle<> coroutine,
-    //                   std::size_t index = 0) {
-    //     instance->mWorkers[index].spawn(coroutine);
-    // }
-    //
-    // template <class T, class P>
-    // static T join(Task<T, P> task, std::size_t index = 0) {
-    //     return instance->mWorkers[index].join(std::move(task));
-    // }
+    // numWorkers = 0 means one worker per hardware thread
+    static void start(std::size_t numWorkers = 0,
+                      IOContextOptions options = {});
+    /* MT-safe */ static void stop();
+    // rethrows the first exception escaped from any of the workers
+    static void join();
+
+    static void run(std::size_t numWorkers = 0, IOContextOptions options = {}) {
+        start(numWorkers, std::move(options));
+        join();
+    }
+
+    /* MT-safe */ static void spawn(std::coroutine_handle<> coroutine,
+                                    std::size_t index) {
+        nth_worker(index).spawn(coroutine);
+    }
+
+    template <Awaitable A>
+    /* MT-safe */ static void spawn(A awaitable, std::size_t index) {
+        nth_worker(index).spawn(std::move(awaitable));
+    }
 
     static IOContextMT *instance;
 };
@@ -16,7 +16,10 @@ co_sleep(std::chrono::steady_clock::time_point expires) {
     auto task = coSleep(expires);
     CancelCallback _(co_await co_cancel, [p = &task.promise()] {
         p->doCancel();
-        std::coroutine_handle<GenericIOContext::TimerNode>::from_promise(*p).resume();
+        // resuming here would let the canceller's frames finish under it
+        GenericIOContext::instance->enqueuePinnedJobMT(
+            std::coroutine_handle<GenericIOContext::TimerNode>::from_promise(
+                *p));
     });
     co_return co_await task;
 }
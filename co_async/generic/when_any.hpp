@@ -40,55 +40,65 @@ when_any(std::vector<T, Alloc> const &tasks) {
     co_return {std::move(result.value()), index};
 }
 
+template <std::size_t I, class Result, class T>
+Task<> whenAnyHelper(std::optional<Result> &result, T task) {
+    auto res = (co_await std::move(task), Void());
+    if (co_await co_cancel) {
+        co_return;
+    }
+    co_await co_cancel.cancel();
+    result.emplace(std::in_place_index<I>, std::move(res));
+}
+
+template <std::size_t I, class Result, class T>
+Task<> whenAnyCommonHelper(std::optional<Result> &result, std::size_t &index,
+                           T task) {
+    auto res = (co_await std::move(task), Void());
+    if (co_await co_cancel) {
+        co_return;
+    }
+    co_await co_cancel.cancel();
+    index = I;
+    result.emplace(std::move(res));
+}
+
+// the tasks are taken by value, so that they live in this frame rather than
+// in lambda captures
+template <class Result, std::size_t... Is, class... Ts>
+Task<Result> whenAnyImpl(std::index_sequence<Is...>, Ts... tasks) {
+    CancelSource cancel(co_await co_cancel);
+    std::optional<Result> result;
+    co_await when_all(co_cancel.bind(
+        cancel, whenAnyHelper<Is>(result, std::move(tasks)))...);
+    co_return std::move(result.value());
+}
+
+template <class Common, std::size_t... Is, class... Ts>
+Task<WhenAnyResult<Common>> whenAnyCommonImpl(std::index_sequence<Is...>,
+                                              Ts... tasks) {
+    CancelSource cancel(co_await co_cancel);
+    std::size_t index = static_cast<std::size_t>(-1);
+    std::optional<Common> result;
+    co_await when_all(co_cancel.bind(
+        cancel, whenAnyCommonHelper<Is>(result, index, std::move(tasks)))...);
+    co_return WhenAnyResult<Common>{std::move(result.value()), index};
+}
+
 template <Awaitable... Ts>
 Task<std::variant<typename AwaitableTraits<Ts>::AvoidRetType...>>
 when_any(Ts &&...tasks) {
-    return co_bind(
-        [&]<std::size_t... Is>(std::index_sequence<Is...>)
-            -> Task<
-                std::variant<typename AwaitableTraits<Ts>::AvoidRetType...>> {
-            CancelSource cancel(co_await co_cancel);
-            std::optional<
-                std::variant<typename AwaitableTraits<Ts>::AvoidRetType...>>
-                result;
-            co_await when_all(co_cancel.bind(
-                cancel,
-                co_bind([&result, task = std::move(tasks)]() mutable -> Task<> {
-                    auto res = (co_await std::move(task), Void());
-                    if (co_await co_cancel) {
-                        co_return;
-                    }
-                    co_await co_cancel.cancel();
-                    result.emplace(std::in_place_index<Is>, std::move(res));
-                }))...);
-            co_return std::move(result.value());
-        },
-        std::make_index_sequence<sizeof...(Ts)>());
+    return whenAnyImpl<
+        std::variant<typename AwaitableTraits<Ts>::AvoidRetType...>>(
+        std::make_index_sequence<sizeof...(Ts)>(),
+        std::remove_cvref_t<Ts>(std::move(tasks))...);
 }
 
 template <Awaitable... Ts, class Common = std::common_type_t<
                                typename AwaitableTraits<Ts>::AvoidRetType...>>
 Task<WhenAnyResult<Common>> when_any_common(Ts &&...tasks) {
-    return co_bind(
-        [&]<std::size_t... Is>(
-            std::index_sequence<Is...>) -> Task<WhenAnyResult<Common>> {
-            CancelSource cancel(co_await co_cancel);
-            std::size_t index = static_cast<std::size_t>(-1);
-            std::optional<Common> result;
-            co_await when_all(co_cancel.bind(
-                cancel, co_bind([&index, &result,
-                                 task = std::move(tasks)]() mutable -> Task<> {
-                    auto res = (co_await std::move(task), Void());
-                    if (co_await co_cancel) {
-                        co_return;
-                    }
-                    co_await co_cancel.cancel();
-                    index = Is;
-                    result.emplace(std::move(res));
-                }))...);
-            co_return WhenAnyResult<Common>{std::move(result.value()), index};
-        },
-        std::make_index_sequence<sizeof...(Ts)>());
+    return whenAnyCommonImpl<Common>(
+        std::make_index_sequence<sizeof...(Ts)>(),
+        std::remove_cvref_t<Ts>(std::move(tasks))...);
 }
 
 template <Awaitable A, class Timeout>
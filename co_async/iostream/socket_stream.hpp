@@ -2,6 +2,7 @@
 #include <co_async/std.hpp>
 #include <co_async/awaiter/task.hpp>
 #include <co_async/generic/io_context.hpp>
+#include <co_async/generic/when_any.hpp>
 #include <co_async/iostream/stream_base.hpp>
 #include <co_async/net/socket_proxy.hpp>
 #include <co_async/platform/socket.hpp>
@@ -9,13 +10,30 @@
 namespace co_async {
 struct SocketStream : Stream {
     Task<Expected<std::size_t>> raw_read(std::span<char> buffer) override {
-        auto ret =
-            co_await socket_read(mFile, buffer, mTimeout, co_await co_cancel);
-        if (ret == std::make_error_code(std::errc::operation_canceled))
-            [[unlikely]] {
-            co_return std::errc::stream_timeout;
+        if (mRecvMultishot) {
+            if (mPending.empty()) {
+                mPending = co_await co_await recvMultishot();
+            }
+            auto n = std::min(buffer.size(), mPending.size());
+            std::memcpy(buffer.data(), mPending.data(), n);
+            mPending = mPending.subspan(n);
+            if (mPending.empty()) {
+                recycleBuffer();
+            }
+            co_return n;
         }
-        co_return ret;
+        co_return co_await recvPlain(buffer);
+    }
+
+    bool raw_has_borrowed_read() const noexcept override {
+        return mRecvMultishot;
+    }
+
+    Task<Expected<std::span<char const>>> raw_read_borrowed() override {
+        if (mPending.empty()) {
+            mPending = co_await co_await recvMultishot();
+        }
+        co_return std::span<char const>(std::exchange(mPending, {}));
     }
 
     Task<Expected<std::size_t>>
@@ -37,15 +55,98 @@ struct SocketStream : Stream {
         return mFile;
     }
 
-    explicit SocketStream(SocketHandle file) : mFile(std::move(file)) {}
+    // with recvMultishot, one multishot recv SQE receives into provided
+    // buffers of this thread's ring, so no buffer is held while idle, the
+    // stream must then stay on the thread it was first read from
+    explicit SocketStream(SocketHandle file, bool recvMultishot = false)
+        : mFile(std::move(file)),
+          mRecvMultishot(recvMultishot) {}
+
+    ~SocketStream() override {
+        recycleBuffer();
+    }
 
     void raw_timeout(std::chrono::steady_clock::duration timeout) override {
         mTimeout = timeout;
     }
 
 private:
+    // recycles the previous buffer, then waits for the next, empty at EOF
+    Task<Expected<std::span<char>>> recvMultishot() {
+        recycleBuffer();
+        while (true) {
+            if (!mRecv) {
+                int group = PlatformIOContext::instance->bufferGroup();
+                if (group < 0) [[unlikely]] {
+                    mRecvMultishot = false;
+                    co_return co_await recvFallback();
+                }
+                mRing = PlatformIOContext::instance;
+                mRecv.emplace();
+                mRecv->prep_recv_multishot(mFile.fileNo(), group, 0);
+                mRecv->onDiscard([ring = mRing](UringMultishotOp::Completion c) {
+                    if (c.flags & IORING_CQE_F_BUFFER) {
+                        ring->recycleBuffer(c.flags);
+                    }
+                });
+            }
+            std::cerr << "DBG wait\n";
+            auto c = co_await co_await co_timeout(mRecv->next(), mTimeout);
+            std::cerr << "DBG cqe " << c.res << ' ' << c.flags << '\n';
+            if (!c.more()) {
+                // ended by EOF, error or running out of buffers
+                mRecv.reset();
+            }
+            if (c.flags & IORING_CQE_F_BUFFER) {
+                mBufferFlags = c.flags;
+                co_return mRing->providedBuffer(c.flags).subspan(
+                    0, static_cast<std::size_t>(std::max(c.res, 0)));
+            }
+            if (c.res == 0) {
+                co_return std::span<char>();
+            }
+            if (c.res == -ENOBUFS) {
+                // other connections hold all buffers, use one of our own
+                co_return co_await recvFallback();
+            }
+            co_await expectError(c.res);
+        }
+    }
+
+    Task<Expected<std::span<char>>> recvFallback() {
+        mFallback = std::make_unique<char[]>(kStreamBufferSize);
+        std::span<char> buf(mFallback.get(), kStreamBufferSize);
+        auto n = co_await co_await recvPlain(buf);
+        co_return buf.subspan(0, n);
+    }
+
+    Task<Expected<std::size_t>> recvPlain(std::span<char> buffer) {
+        auto ret =
+            co_await socket_read(mFile, buffer, mTimeout, co_await co_cancel);
+        if (ret == std::make_error_code(std::errc::operation_canceled))
+            [[unlikely]] {
+            co_return std::errc::stream_timeout;
+        }
+        co_return ret;
+    }
+
+    void recycleBuffer() noexcept {
+        if (mBufferFlags) {
+            mRing->recycleBuffer(*mBufferFlags);
+            mBufferFlags.reset();
+        }
+        mFallback.reset();
+    }
+
     SocketHandle mFile;
     std::chrono::steady_clock::duration mTimeout = std::chrono::seconds(30);
+    bool mRecvMultishot;
+    std::optional<UringMultishotOp> mRecv;
+    // unread part of the buffer last received
+    std::span<char> mPending;
+    std::optional<unsigned int> mBufferFlags;
+    std::unique_ptr<char[]> mFallback;
+    PlatformIOContext *mRing = nullptr;
 };
 
 inline Task<Expected<OwningStream>>
@@ -44,6 +44,16 @@ struct Stream {
         co_return std::errc::not_supported;
     }
 
+    // streams receiving into buffers of their own lend them out instead of
+    // copying into ours, valid until the next read, empty at end of file
+    virtual bool raw_has_borrowed_read() const noexcept {
+        return false;
+    }
+
+    virtual Task<Expected<std::span<char const>>> raw_read_borrowed() {
+        co_return std::errc::not_supported;
+    }
+
     Stream &operator=(Stream &&) = delete;
     virtual ~Stream() = default;
 };
@@ -62,7 +72,7 @@ struct BorrowedStream {
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
         }
-        char c = mInBuffer[mInIndex];
+        char c = mInData[mInIndex];
         ++mInIndex;
         co_return c;
     }
@@ -71,13 +81,13 @@ struct BorrowedStream {
         std::size_t start = mInIndex;
         while (true) {
             for (std::size_t i = start; i < mInEnd; ++i) {
-                if (mInBuffer[i] == eol) {
-                    s.append(mInBuffer.data() + start, i - start);
+                if (mInData[i] == eol) {
+                    s.append(mInData + start, i - start);
                     mInIndex = i + 1;
                     co_return {};
                 }
             }
-            s.append(mInBuffer.data() + start, mInEnd - start);
+            s.append(mInData + start, mInEnd - start);
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
             start = 0;
@@ -88,7 +98,7 @@ struct BorrowedStream {
         std::size_t start = mInIndex;
         while (true) {
             for (std::size_t i = start; i < mInEnd; ++i) {
-                if (mInBuffer[i] == eol) {
+                if (mInData[i] == eol) {
                     mInIndex = i + 1;
                     co_return {};
                 }
@@ -107,7 +117,7 @@ struct BorrowedStream {
                 mInEnd = mInIndex = 0;
                 co_await co_await fillbuf();
             }
-            char c = mInBuffer[mInIndex];
+            char c = mInData[mInIndex];
             if (eol[i] == c) [[likely]] {
                 ++mInIndex;
             } else {
@@ -126,7 +136,7 @@ struct BorrowedStream {
                 mInEnd = mInIndex = 0;
                 co_await co_await fillbuf();
             }
-            char c = mInBuffer[mInIndex];
+            char c = mInData[mInIndex];
             if (eol[i] == c) [[likely]] {
                 ++mInIndex;
             } else {
@@ -155,13 +165,11 @@ struct BorrowedStream {
         while (true) {
             auto end = start + n;
             if (end <= mInEnd) {
-                p = std::copy(mInBuffer.data() + start, mInBuffer.data() + end,
-                              p);
+                p = std::copy(mInData + start, mInData + end, p);
                 mInIndex = end;
                 co_return {};
             }
-            p = std::copy(mInBuffer.data() + start, mInBuffer.data() + mInEnd,
-                          p);
+            p = std::copy(mInData + start, mInData + mInEnd, p);
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
             start = 0;
@@ -189,13 +197,13 @@ struct BorrowedStream {
         while (true) {
             auto end = start + n;
             if (end <= mInEnd) {
-                s.append(mInBuffer.data() + mInIndex, n);
+                s.append(mInData + mInIndex, n);
                 mInIndex = end;
                 co_return {};
             }
             auto m = mInEnd - mInIndex;
             n -= m;
-            s.append(mInBuffer.data() + mInIndex, m);
+            s.append(mInData + mInIndex, m);
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
             start = 0;
@@ -219,7 +227,7 @@ struct BorrowedStream {
     Task<Expected<>> getall(String &s) {
         std::size_t start = mInIndex;
         do {
-            s.append(mInBuffer.data() + start, mInEnd - start);
+            s.append(mInData + start, mInEnd - start);
             start = 0;
             mInEnd = mInIndex = 0;
         } while (co_await (co_await fillbuf()).transform([] { return true; }).or_else(eofError(), [] { return false; }));
@@ -248,7 +256,7 @@ struct BorrowedStream {
     }
 
     std::span<char const> peekbuf() const noexcept {
-        return {mInBuffer.data() + mInIndex, mInEnd - mInIndex};
+        return {mInData + mInIndex, mInEnd - mInIndex};
     }
 
     void seenbuf(std::size_t n) noexcept {
@@ -279,10 +287,13 @@ struct BorrowedStream {
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
         }
-        co_return mInBuffer[mInIndex];
+        co_return mInData[mInIndex];
     }
 
     Task<Expected<>> peekn(String &s, std::size_t n) {
+        if (mInBorrowed) {
+            adoptinbuf();
+        }
         if (mInBuffer.size() - mInIndex < n) {
             if (mInBuffer.size() < n) [[unlikely]] {
                 co_return std::errc::value_too_large;
@@ -308,12 +319,44 @@ struct BorrowedStream {
     void allocinbuf(std::size_t size) {
         if (!mInBuffer) [[likely]] {
             mInBuffer.allocate(size);
+            mInData = mInBuffer.data();
             mInIndex = 0;
             mInEnd = 0;
         }
     }
 
+    // move what is left of a borrowed buffer into our own
+    void adoptinbuf() {
+        auto n = mInEnd - mInIndex;
+        if (mInBuffer.size() < n) [[unlikely]] {
+            mInBuffer.allocate(std::max(n, kStreamBufferSize));
+        }
+        if (!mInBuffer) {
+            mInBuffer.allocate(kStreamBufferSize);
+        }
+        std::memmove(mInBuffer.data(), mInData + mInIndex, n);
+        mInData = mInBuffer.data();
+        mInIndex = 0;
+        mInEnd = n;
+        mInBorrowed = false;
+    }
+
     Task<Expected<>> fillbuf() {
+        if (bufempty() && mRaw->raw_has_borrowed_read()) {
+            // we hold no buffer while waiting, the old one goes back now
+            auto buf = co_await co_await mRaw->raw_read_borrowed();
+            if (buf.empty()) [[unlikely]] {
+                co_return eofError();
+            }
+            mInData = const_cast<char *>(buf.data());
+            mInIndex = 0;
+            mInEnd = buf.size();
+            mInBorrowed = true;
+            co_return {};
+        }
+        if (mInBorrowed) {
+            adoptinbuf();
+        }
         if (!mInBuffer) {
             allocinbuf(kStreamBufferSize);
         }
@@ -477,7 +520,7 @@ struct BorrowedStream {
     Task<Expected<std::size_t>> read(std::span<char> buffer) {
         if (!bufempty()) {
             auto n = std::min(mInEnd - mInIndex, buffer.size());
-            std::memcpy(buffer.data(), mInBuffer.data() + mInIndex, n);
+            std::memcpy(buffer.data(), mInData + mInIndex, n);
             mInIndex += n;
             co_return n;
         }
@@ -530,6 +573,9 @@ struct BorrowedStream {
 
 private:
     BytesBuffer mInBuffer;
+    // points into mInBuffer, or a buffer lent by raw_read_borrowed
+    char *mInData = nullptr;
+    bool mInBorrowed = false;
     std::size_t mInIndex = 0;
     std::size_t mInEnd = 0;
     BytesBuffer mOutBuffer;
@@ -1,4 +1,5 @@
 #include <co_async/awaiter/task.hpp>
+#include <co_async/generic/io_context_mt.hpp>
 #include <co_async/iostream/socket_stream.hpp>
 #include <co_async/iostream/ssl_socket_stream.hpp>
 #include <co_async/net/http_protocol.hpp>
@@ -85,6 +86,7 @@ struct HTTPServer::Impl {
         co_return co_await make_error_response(io, 404);
     };
     std::chrono::steady_clock::duration mTimeout = std::chrono::seconds(30);
+    bool mRecvMultishot = false;
 #if CO_ASYNC_DEBUG
     bool mLogRequests = false;
 #endif
@@ -206,6 +208,10 @@ void HTTPServer::timeout(std::chrono::steady_clock::duration timeout) {
     mImpl->mTimeout = timeout;
 }
 
+void HTTPServer::enableRecvMultishot() {
+    mImpl->mRecvMultishot = true;
+}
+
 void HTTPServer::route(std::string_view methods, std::string_view path,
                        HTTPHandler handler) {
     mImpl->mRoutes.insert_or_assign(
@@ -248,7 +254,8 @@ HTTPServer::prepareHTTPS(SocketHandle handle, SSLServerState &https) const {
 
 Task<std::unique_ptr<HTTPProtocol>>
 HTTPServer::prepareHTTP(SocketHandle handle) const {
-    auto sock = make_stream<SocketStream>(std::move(handle));
+    auto sock =
+        make_stream<SocketStream>(std::move(handle), mImpl->mRecvMultishot);
     sock.timeout(mImpl->mTimeout);
     co_return std::make_unique<HTTPProtocolVersion11>(std::move(sock));
 }
@@ -312,6 +319,30 @@ Task<Expected<>> HTTPServer::handle_https(SocketHandle handle,
     co_return {};
 }
 
+Task<Expected<>> HTTPServer::serve(SocketListener &listener,
+                                   std::size_t workers) const {
+    if (IOContextMT::instance) {
+        if (workers == 0 || workers > IOContextMT::num_workers()) {
+            workers = IOContextMT::num_workers();
+        }
+    } else {
+        workers = 0;
+    }
+    auto incomes = listener_accept_multishot(listener);
+    std::size_t i = 0;
+    while (auto income = co_await co_await incomes) {
+        if (workers) {
+            IOContextMT::spawn(handle_http(std::move(*income)), i);
+            if (++i == workers) {
+                i = 0;
+            }
+        } else {
+            co_spawn(handle_http(std::move(*income)));
+        }
+    }
+    co_return {};
+}
+
 Task<Expected<>>
 HTTPServer::doHandleConnection(std::unique_ptr<HTTPProtocol> http) const {
     while (true) {
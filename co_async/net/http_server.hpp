@@ -62,6 +62,8 @@ struct HTTPServer {
     void enableLogRequests();
 #endif
     void timeout(std::chrono::steady_clock::duration timeout);
+    // receive through provided buffers, idle connections hold none
+    void enableRecvMultishot();
     void route(std::string_view methods, std::string_view path,
                HTTPHandler handler);
     void route(std::string_view methods, std::string_view prefix,
@@ -76,6 +78,11 @@ struct HTTPServer {
                                   SSLServerState &https) const;
     Task<Expected<>>
     doHandleConnection(std::unique_ptr<HTTPProtocol> http) const;
+    // accept with one multishot SQE and hand each connection to the next of
+    // the first `workers` IOContextMT workers (0 for all of them), handled on
+    // this thread if IOContextMT is not running
+    Task<Expected<>> serve(SocketListener &listener,
+                           std::size_t workers = 0) const;
     static Task<Expected<>> make_error_response(IO &io, int status);
 
 private:
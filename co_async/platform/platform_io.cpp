@@ -127,13 +127,95 @@ PlatformIOContext::PlatformIOContext() noexcept {
     mRing.ring_fd = -1;
 }
 
-void PlatformIOContext::setup(std::size_t entries) {
+void PlatformIOContext::setup(std::size_t entries,
+                              IOUringOptions const &options) {
     unsigned int flags = 0;
 #if CO_ASYNC_DIRECT
     flags |= IORING_SETUP_IOPOLL;
 #endif
-    throwingError(
-        io_uring_queue_init(static_cast<unsigned int>(entries), &mRing, flags));
+    if (options.sqPoll) {
+        flags |= IORING_SETUP_SQPOLL;
+        if (options.sqPollCpu) {
+            flags |= IORING_SETUP_SQ_AFF;
+        }
+    }
+    if (options.coopTaskRun) {
+        flags |= IORING_SETUP_COOP_TASKRUN;
+    }
+    if (options.taskRunFlag) {
+        flags |= IORING_SETUP_TASKRUN_FLAG;
+    }
+    if (options.singleIssuer || options.deferTaskRun) {
+        flags |= IORING_SETUP_SINGLE_ISSUER;
+    }
+    if (options.deferTaskRun) {
+        flags |= IORING_SETUP_DEFER_TASKRUN;
+    }
+    if (options.cqEntries) {
+        flags |= IORING_SETUP_CQSIZE;
+    }
+    // newest first, so that older kernels keep as many flags as they know
+    static constexpr unsigned int fallbacks[] = {
+        IORING_SETUP_DEFER_TASKRUN, IORING_SETUP_SINGLE_ISSUER,
+        IORING_SETUP_TASKRUN_FLAG,  IORING_SETUP_COOP_TASKRUN,
+        IORING_SETUP_SQ_AFF,        IORING_SETUP_SQPOLL,
+        IORING_SETUP_CQSIZE,
+    };
+    while (true) {
+        struct io_uring_params params = {};
+        params.flags = flags;
+        params.sq_thread_idle =
+            static_cast<unsigned int>(options.sqPollIdle.count());
+        params.sq_thread_cpu =
+            static_cast<unsigned int>(options.sqPollCpu.value_or(0));
+        params.cq_entries = static_cast<unsigned int>(options.cqEntries);
+        int res = io_uring_queue_init_params(static_cast<unsigned int>(entries),
+                                             &mRing, &params);
+        if (res >= 0) {
+            break;
+        }
+        auto it = std::find_if(std::begin(fallbacks), std::end(fallbacks),
+                               [&](unsigned int f) { return flags & f; });
+        // EPERM for SQPOLL without privileges on kernels before 5.11
+        if ((res != -EINVAL && res != -EPERM) || it == std::end(fallbacks)) {
+            throw std::system_error(-res, std::system_category());
+        }
+        flags &= ~*it;
+        if (*it == IORING_SETUP_SQPOLL) {
+            flags &= ~IORING_SETUP_SQ_AFF;
+        }
+    }
+    mCompletions =
+        std::make_unique<std::coroutine_handle<>[]>(mRing.cq.ring_entries);
+    // ring size must be a power of two below 32768
+    mBufRingEntries = static_cast<unsigned int>(
+        std::bit_floor(std::clamp<std::size_t>(options.bufferRingEntries, 1,
+                                               32768)));
+    mBufRingSize = options.bufferRingSize;
+    if (auto *probe = io_uring_get_probe_ring(&mRing)) {
+        mMessageSupported =
+            io_uring_opcode_supported(probe, IORING_OP_MSG_RING);
+        io_uring_free_probe(probe);
+    }
+}
+
+bool PlatformIOContext::postMessage(PlatformIOContext &target,
+                                    std::uint64_t data) {
+    if (!mMessageSupported) [[unlikely]] {
+        return false;
+    }
+    UringOp()
+        .prep_msg_ring(target.mRing.ring_fd, 0, data | kMessageTag, 0)
+        .startDetach();
+    // the target may be sleeping right now, do not wait for our next turn
+    countSubmit();
+    int res = io_uring_submit(&mRing);
+    if (res < 0) [[unlikely]] {
+        if (res != -EINTR) {
+            throw std::system_error(-res, std::system_category());
+        }
+    }
+    return true;
 }
 
 void PlatformIOContext::reserveBuffers(std::size_t nbufs) {
@@ -205,7 +287,69 @@ std::size_t PlatformIOContext::addFiles(std::span<int const> files) {
     return ret;
 }
 
+void PlatformIOContext::destroyPendingMessages() {
+    if (mRing.ring_fd == -1) {
+        return;
+    }
+    struct io_uring_cqe *cqe;
+    unsigned head, numGot = 0, numExtra = 0;
+    io_uring_for_each_cqe(&mRing, head, cqe) {
+        if (cqe->user_data & kMessageTag) {
+            if (auto address = cqe->user_data & ~kMessageTag;
+                address && cqe->user_data != LIBURING_UDATA_TIMEOUT) {
+                std::coroutine_handle<>::from_address(
+                    reinterpret_cast<void *>(address))
+                    .destroy();
+            }
+            ++numExtra;
+        } else if (cqe->user_data & kMultishotTag) {
+            // frees orphaned states, waiters are not resumed any more
+            UringMultishotOp::Completion c{cqe->res, cqe->flags};
+            (void)UringMultishotOp::complete(cqe->user_data, c);
+            if (c.more()) {
+                ++numExtra;
+            }
+        }
+        ++numGot;
+    }
+    io_uring_cq_advance(&mRing, numGot);
+    mNumSqesPending -= static_cast<std::size_t>(numGot - numExtra);
+}
+
+int PlatformIOContext::bufferGroup() {
+    static constexpr int kBufferGroup = 0;
+    if (mBufRing) [[likely]] {
+        return kBufferGroup;
+    }
+    if (mBufRingUnsupported) {
+        return -1;
+    }
+    int res;
+    mBufRing = io_uring_setup_buf_ring(&mRing, mBufRingEntries, kBufferGroup,
+                                       0, &res);
+    if (!mBufRing) {
+        if (res != -EINVAL && res != -ENOSYS) [[unlikely]] {
+            throw std::system_error(-res, std::system_category());
+        }
+        mBufRingUnsupported = true;
+        return -1;
+    }
+    mBufRingData = std::make_unique<char[]>(mBufRingEntries * mBufRingSize);
+    for (unsigned int i = 0; i < mBufRingEntries; ++i) {
+        io_uring_buf_ring_add(mBufRing, mBufRingData.get() + i * mBufRingSize,
+                              static_cast<unsigned int>(mBufRingSize),
+                              static_cast<unsigned short>(i),
+                              io_uring_buf_ring_mask(mBufRingEntries),
+                              static_cast<int>(i));
+    }
+    io_uring_buf_ring_advance(mBufRing, static_cast<int>(mBufRingEntries));
+    return kBufferGroup;
+}
+
 PlatformIOContext::~PlatformIOContext() {
+    if (mBufRing) {
+        io_uring_free_buf_ring(&mRing, mBufRing, mBufRingEntries, 0);
+    }
     if (mRing.ring_fd != -1) {
         io_uring_queue_exit(&mRing);
     }
@@ -213,9 +357,17 @@ PlatformIOContext::~PlatformIOContext() {
 
 thread_local PlatformIOContext *PlatformIOContext::instance;
 
-bool PlatformIOContext::waitEventsFor(
+bool PlatformIOContext::waitEvents(
     std::optional<std::chrono::steady_clock::duration> timeout) {
     // debug(), "wait", this, mNumSqesPending;
+    if (io_uring_sq_ready(&mRing) < mSubmitBatch && io_uring_cq_ready(&mRing) &&
+        !(IO_URING_READ_ONCE(*mRing.sq.kflags) &
+          (IORING_SQ_CQ_OVERFLOW | IORING_SQ_TASKRUN))) {
+        // completions already there, keep SQEs for a bigger batch
+        ++mStats.numEntersSkipped;
+        return true;
+    }
+    countSubmit();
     struct io_uring_cqe *cqe;
     struct __kernel_timespec ts, *tsp;
     if (timeout) {
@@ -232,8 +384,13 @@ bool PlatformIOContext::waitEventsFor(
         }
         throw std::system_error(-res, std::system_category());
     }
-    unsigned head, numGot = 0;
-    std::vector<std::coroutine_handle<>> tasks;
+    return true;
+}
+
+void PlatformIOContext::dispatchEvents() {
+    struct io_uring_cqe *cqe;
+    unsigned head, numGot = 0, numExtra = 0;
+    std::size_t numTasks = 0;
     io_uring_for_each_cqe(&mRing, head, cqe) {
 #if CO_ASYNC_INVALFIX
         if (cqe->user_data == LIBURING_UDATA_TIMEOUT) [[unlikely]] {
@@ -241,24 +398,48 @@ bool PlatformIOContext::waitEventsFor(
             continue;
         }
 #endif
+        if (cqe->user_data & kMessageTag) [[unlikely]] {
+            // posted from other ring (or liburing internal timeout), no SQE
+            // of ours consumed
+            if (auto address = cqe->user_data & ~kMessageTag;
+                address && cqe->user_data != LIBURING_UDATA_TIMEOUT) {
+                mCompletions[numTasks++] = std::coroutine_handle<>::from_address(
+                    reinterpret_cast<void *>(address));
+            }
+            ++numGot;
+            ++numExtra;
+            continue;
+        }
+        if (cqe->user_data & kMultishotTag) {
+            UringMultishotOp::Completion c{cqe->res, cqe->flags};
+            if (auto task = UringMultishotOp::complete(cqe->user_data, c)) {
+                mCompletions[numTasks++] = task;
+            }
+            // the SQE is only consumed by its final CQE
+            if (c.more()) {
+                ++numExtra;
+            }
+            ++numGot;
+            continue;
+        }
         auto *op = reinterpret_cast<UringOp *>(cqe->user_data);
         op->mRes = cqe->res;
-        tasks.push_back(op->mPrevious);
+        mCompletions[numTasks++] = op->mPrevious;
         ++numGot;
     }
     io_uring_cq_advance(&mRing, numGot);
-    mNumSqesPending -= static_cast<std::size_t>(numGot);
-    for (auto const &task: tasks) {
+    mNumSqesPending -= static_cast<std::size_t>(numGot - numExtra);
+    for (std::size_t i = 0; i < numTasks; ++i) {
+        auto task = mCompletions[i];
 #if CO_ASYNC_DEBUG
-        if (!task) [[likely]] {
+        if (!task) [[unlikely]] {
             std::cerr << "null coroutine pushed into task queue\n";
         }
-        if (task.done()) [[likely]] {
+        if (task.done()) [[unlikely]] {
             std::cerr << "done coroutine pushed into task queue\n";
         }
 #endif
         task.resume();
     }
-    return true;
 }
 } // namespace co_async
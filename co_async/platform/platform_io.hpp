@@ -30,6 +30,29 @@ timePointToKernelTimespec(std::chrono::time_point<Clk, Dur> tp) {
     return durationToKernelTimespec(tp.time_since_epoch());
 }
 
+// io_uring setup flags, each one silently dropped if the kernel rejects it
+struct IOUringOptions {
+    // a kernel thread polls the SQ, submitting needs no syscall
+    bool sqPoll = false;
+    // the polling thread sleeps after being idle for this long
+    std::chrono::milliseconds sqPollIdle = std::chrono::milliseconds(1000);
+    std::optional<std::size_t> sqPollCpu = std::nullopt;
+    // completions wait for our next syscall instead of interrupting us
+    bool coopTaskRun = false;
+    // mark the SQ ring when completions wait for us to enter the kernel
+    bool taskRunFlag = false;
+    // only the thread calling setup submits to the ring
+    bool singleIssuer = false;
+    // completions run only when we wait for them, implies singleIssuer
+    bool deferTaskRun = false;
+    // CQ ring size, 0 for twice the SQ entries
+    std::size_t cqEntries = 0;
+    // provided buffer ring for recvs picking their buffer on arrival,
+    // allocated on first use
+    std::size_t bufferRingEntries = 256;
+    std::size_t bufferRingSize = 8192;
+};
+
 struct PlatformIOContext {
     [[gnu::cold]] static void schedSetThreadAffinity(size_t cpu);
 
@@ -45,11 +68,46 @@ struct PlatformIOContext {
     };
 
     [[gnu::hot]] bool
-    waitEventsFor(std::optional<std::chrono::steady_clock::duration> timeout);
+    waitEventsFor(std::optional<std::chrono::steady_clock::duration> timeout) {
+        if (!waitEvents(timeout)) {
+            return false;
+        }
+        dispatchEvents();
+        return true;
+    }
+
+    // submit and block until any CQE arrived, false if timed out
+    [[gnu::hot]] bool
+    waitEvents(std::optional<std::chrono::steady_clock::duration> timeout);
+    // resume coroutines of all CQEs arrived
+    [[gnu::hot]] void dispatchEvents();
+
+    struct Stats {
+        std::uint64_t numEnters = 0;        // io_uring_enter calls
+        std::uint64_t numSubmits = 0;       // of which submitted any SQE
+        std::uint64_t numSqesSubmitted = 0; // divide by numSubmits for batch
+        std::uint64_t numEntersSkipped = 0; // turns served without syscall
+    };
+
+    Stats const &stats() const noexcept {
+        return mStats;
+    }
+
+    // let up to n SQEs pile up while completions are still there to handle
+    void setSubmitBatch(std::size_t n) noexcept {
+        mSubmitBatch = static_cast<unsigned int>(n);
+    }
 
     [[gnu::hot]] struct io_uring_sqe *getSqe() {
         struct io_uring_sqe *sqe = io_uring_get_sqe(&mRing);
         while (!sqe) {
+            if (mRing.flags & IORING_SETUP_SQPOLL) {
+                // SQ full until the polling thread consumed some entries
+                throwingError(io_uring_sqring_wait(&mRing));
+                sqe = io_uring_get_sqe(&mRing);
+                continue;
+            }
+            countSubmit();
             int res = io_uring_submit(&mRing);
             if (res < 0) [[unlikely]] {
                 if (res == -EINTR) {
@@ -65,7 +123,8 @@ struct PlatformIOContext {
 
     PlatformIOContext &operator=(PlatformIOContext &&) = delete;
     [[gnu::cold]] PlatformIOContext() noexcept;
-    [[gnu::cold]] void setup(std::size_t entries);
+    [[gnu::cold]] void setup(std::size_t entries,
+                             IOUringOptions const &options = {});
     [[gnu::cold]] ~PlatformIOContext();
     static thread_local PlatformIOContext *instance;
 
@@ -74,19 +133,74 @@ struct PlatformIOContext {
     void reserveFiles(std::size_t nfiles);
     std::size_t addFiles(std::span<int const> files);
 
+    // IORING_SETUP_* flags the kernel accepted
+    unsigned int setupFlags() const noexcept {
+        return mRing.flags;
+    }
+
     std::size_t hasPendingEvents() const noexcept {
         return mNumSqesPending != 0;
     }
 
+    // CQEs posted by other rings through IORING_OP_MSG_RING have this bit set
+    // in their user_data, a UringOp pointer is always aligned so never has it
+    static constexpr std::uint64_t kMessageTag = 1;
+    // CQEs of a UringMultishotOp, whose state pointer is also aligned
+    static constexpr std::uint64_t kMultishotTag = 2;
+
+    // post a CQE to the target ring, false if IORING_OP_MSG_RING unsupported,
+    // data may be the address of a coroutine to be resumed by the target
+    bool postMessage(PlatformIOContext &target, std::uint64_t data = 0);
+    // destroy coroutines posted to us but never resumed
+    void destroyPendingMessages();
+
+    // buffer group id for IOSQE_BUFFER_SELECT, sets up the ring of provided
+    // buffers on first call, -1 if the kernel lacks them (before 5.19)
+    int bufferGroup();
+
+    // the buffer a CQE with IORING_CQE_F_BUFFER was given
+    std::span<char> providedBuffer(unsigned int flags) const noexcept {
+        auto bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        return {mBufRingData.get() + bid * mBufRingSize, mBufRingSize};
+    }
+
+    // hand the buffer of such CQE back to the kernel when done with it
+    void recycleBuffer(unsigned int flags) noexcept {
+        auto bid = static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT);
+        io_uring_buf_ring_add(mBufRing, mBufRingData.get() + bid * mBufRingSize,
+                              static_cast<unsigned int>(mBufRingSize), bid,
+                              io_uring_buf_ring_mask(mBufRingEntries), 0);
+        io_uring_buf_ring_advance(mBufRing, 1);
+    }
+
 private:
+    void countSubmit() noexcept {
+        unsigned numReady = io_uring_sq_ready(&mRing);
+        ++mStats.numEnters;
+        if (numReady) {
+            ++mStats.numSubmits;
+            mStats.numSqesSubmitted += numReady;
+        }
+    }
+
     struct io_uring mRing;
     std::size_t mNumSqesPending = 0;
+    unsigned int mSubmitBatch = 0;
+    Stats mStats;
+    // holds coroutines of CQEs from one turn, as many as the CQ ring can
+    std::unique_ptr<std::coroutine_handle<>[]> mCompletions;
+    bool mMessageSupported = false;
     std::unique_ptr<struct iovec[]> mBuffers;
     unsigned int mNumBufs = 0;
     unsigned int mCapBufs = 0;
     std::unique_ptr<int[]> mFiles;
     unsigned int mNumFiles = 0;
     unsigned int mCapFiles = 0;
+    struct io_uring_buf_ring *mBufRing = nullptr;
+    std::unique_ptr<char[]> mBufRingData;
+    unsigned int mBufRingEntries = 0;
+    std::size_t mBufRingSize = 0;
+    bool mBufRingUnsupported = false;
 };
 
 struct [[nodiscard]] UringOp {
@@ -339,11 +453,27 @@ public:
         return std::move(*this);
     }
 
+    UringOp &&prep_cancel64(std::uint64_t user_data, int flags) && {
+        io_uring_prep_cancel64(mSqe, user_data, flags);
+        return std::move(*this);
+    }
+
+    UringOp &&prep_close_direct(unsigned int file_index) && {
+        io_uring_prep_close_direct(mSqe, file_index);
+        return std::move(*this);
+    }
+
     UringOp &&prep_cancel_fd(int fd, unsigned int flags) && {
         io_uring_prep_cancel_fd(mSqe, fd, flags);
         return std::move(*this);
     }
 
+    UringOp &&prep_msg_ring(int fd, unsigned int len, __u64 data,
+                            unsigned int flags) && {
+        io_uring_prep_msg_ring(mSqe, fd, len, data, flags);
+        return std::move(*this);
+    }
+
     UringOp &&prep_waitid(idtype_t idtype, id_t id, siginfo_t *infop,
                           int options, unsigned int flags) && {
         io_uring_prep_waitid(mSqe, idtype, id, infop, options, flags);
@@ -422,4 +552,175 @@ public:
     // }
 };
 
+// one SQE completing with many CQEs for as long as IORING_CQE_F_MORE is set,
+// CQEs queue up until awaited, one at a time
+struct [[nodiscard]] UringMultishotOp {
+private:
+    struct State;
+
+public:
+    struct Completion {
+        int res;
+        unsigned int flags;
+
+        // false for the final CQE, do not await any more after it
+        bool more() const noexcept {
+            return flags & IORING_CQE_F_MORE;
+        }
+    };
+
+    UringMultishotOp() : mState(new State) {
+        mSqe = PlatformIOContext::instance->getSqe();
+        io_uring_sqe_set_data64(mSqe, userData());
+    }
+
+    UringMultishotOp(UringMultishotOp &&) = delete;
+
+    // the kernel may still post CQEs after we are gone, so when destroyed
+    // before the final CQE, cancel and leave the state to dispatchEvents
+    ~UringMultishotOp() {
+        for (auto const &c: mState->mQueue) {
+            if (mState->mDiscard) {
+                mState->mDiscard(c);
+            }
+        }
+        mState->mQueue.clear();
+        if (mState->mFinished) {
+            delete mState;
+            return;
+        }
+        mState->mOrphaned = true;
+        UringOp().prep_cancel64(userData(), 0).startDetach();
+    }
+
+    // for completions never awaited, e.g. to close accepted sockets
+    void onDiscard(std::function<void(Completion)> discard) {
+        mState->mDiscard = std::move(discard);
+    }
+
+    struct Awaiter {
+        bool await_ready() const noexcept {
+            return !mState->mQueue.empty();
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            mState->mWaiting = coroutine;
+        }
+
+        Completion await_resume() noexcept {
+            auto c = mState->mQueue.front();
+            mState->mQueue.pop_front();
+            return c;
+        }
+
+        State *mState;
+    };
+
+    Awaiter operator co_await() noexcept {
+        return Awaiter{mState};
+    }
+
+    // like co_await, but co_cancel stops the waiting, not the SQE
+    Task<Expected<Completion>> next() {
+        if (mState->mQueue.empty()) {
+            auto cancel = co_await co_cancel;
+            if (cancel.is_canceled()) [[unlikely]] {
+                co_return std::errc::operation_canceled;
+            }
+            CancelCallback _(cancel, [state = mState] {
+                if (auto waiting = std::exchange(state->mWaiting, nullptr)) {
+                    co_spawn(waiting);
+                }
+            });
+            co_await WaitAwaiter{mState};
+            if (mState->mQueue.empty()) {
+                co_return std::errc::operation_canceled;
+            }
+        }
+        co_return co_await Awaiter{mState};
+    }
+
+    struct io_uring_sqe *getSqe() const noexcept {
+        return mSqe;
+    }
+
+    UringMultishotOp &prep_multishot_accept(int fd, struct sockaddr *addr,
+                                            socklen_t *addrlen, int flags) & {
+        io_uring_prep_multishot_accept(mSqe, fd, addr, addrlen, flags);
+        return *this;
+    }
+
+    UringMultishotOp &prep_multishot_accept_direct(int fd,
+                                                   struct sockaddr *addr,
+                                                   socklen_t *addrlen,
+                                                   int flags) & {
+        io_uring_prep_multishot_accept_direct(mSqe, fd, addr, addrlen, flags);
+        return *this;
+    }
+
+    // each CQE comes with a buffer of PlatformIOContext::bufferGroup(),
+    // hand it back with PlatformIOContext::recycleBuffer
+    UringMultishotOp &prep_recv_multishot(int fd, int bufferGroup,
+                                          int flags) & {
+        io_uring_prep_recv_multishot(mSqe, fd, nullptr, 0, flags);
+        mSqe->flags |= IOSQE_BUFFER_SELECT;
+        mSqe->buf_group = static_cast<__u16>(bufferGroup);
+        return *this;
+    }
+
+private:
+    struct WaitAwaiter {
+        bool await_ready() const noexcept {
+            return !mState->mQueue.empty();
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            mState->mWaiting = coroutine;
+        }
+
+        void await_resume() const noexcept {}
+
+        State *mState;
+    };
+
+    struct State {
+        std::deque<Completion> mQueue;
+        std::coroutine_handle<> mWaiting;
+        std::function<void(Completion)> mDiscard;
+        bool mFinished = false;
+        bool mOrphaned = false;
+    };
+
+    std::uint64_t userData() const noexcept {
+        return reinterpret_cast<std::uintptr_t>(mState) |
+               PlatformIOContext::kMultishotTag;
+    }
+
+    // called by dispatchEvents, returns the coroutine to resume if any
+    static std::coroutine_handle<> complete(std::uint64_t userData,
+                                            Completion c) {
+        auto *state = reinterpret_cast<State *>(
+            userData & ~PlatformIOContext::kMultishotTag);
+        if (!c.more()) {
+            state->mFinished = true;
+        }
+        if (state->mOrphaned) [[unlikely]] {
+            if (state->mDiscard) {
+                state->mDiscard(c);
+            }
+            if (state->mFinished) {
+                delete state;
+            }
+            return nullptr;
+        }
+        state->mQueue.push_back(c);
+        return std::exchange(state->mWaiting, nullptr);
+    }
+
+    State *mState;
+    struct io_uring_sqe *mSqe;
+
+    friend PlatformIOContext;
+};
+
 } // namespace co_async
@@ -369,6 +369,75 @@ Task<Expected<SocketHandle>> listener_accept(SocketListener &listener,
     co_return sock;
 }
 
+namespace {
+// the peer gave up or we ran out of descriptors, the listener is still fine
+bool isTransientAcceptError(int err) noexcept {
+    return err == ECONNABORTED || err == EINTR || err == EAGAIN ||
+           err == EMFILE || err == ENFILE || err == ENOBUFS || err == ENOMEM;
+}
+} // namespace
+
+Task<GeneratorResult<SocketHandle, Expected<>>>
+listener_accept_multishot(SocketListener &listener) {
+    bool accepted = false;
+    while (true) {
+        UringMultishotOp op;
+        op.prep_multishot_accept(listener.fileNo(), nullptr, nullptr, 0);
+        op.onDiscard([](UringMultishotOp::Completion c) {
+            if (c.res >= 0) {
+                close(c.res);
+            }
+        });
+        while (true) {
+            auto c = co_await op;
+            if (c.res == -EINVAL && !accepted) [[unlikely]] {
+                // multishot accept needs kernel 5.19
+                while (true) {
+                    auto income = co_await listener_accept(listener);
+                    if (income.has_value()) {
+                        co_yield std::move(*income);
+                    } else if (!isTransientAcceptError(income.error().value())) {
+                        co_await std::move(income);
+                    }
+                }
+            }
+            if (c.res >= 0) {
+                accepted = true;
+                co_yield SocketHandle(c.res);
+            } else if (!isTransientAcceptError(-c.res)) {
+                co_await expectError(c.res);
+            }
+            // the kernel stops posting on CQ overflow, arm again
+            if (!c.more()) {
+                break;
+            }
+        }
+    }
+}
+
+Task<GeneratorResult<unsigned int, Expected<>>>
+listener_accept_multishot_direct(SocketListener &listener) {
+    while (true) {
+        UringMultishotOp op;
+        op.prep_multishot_accept_direct(listener.fileNo(), nullptr, nullptr,
+                                        0);
+        op.onDiscard([](UringMultishotOp::Completion c) {
+            if (c.res >= 0) {
+                UringOp()
+                    .prep_close_direct(static_cast<unsigned int>(c.res))
+                    .startDetach();
+            }
+        });
+        while (true) {
+            auto c = co_await op;
+            co_yield static_cast<unsigned int>(co_await expectError(c.res));
+            if (!c.more()) {
+                break;
+            }
+        }
+    }
+}
+
 Task<Expected<std::size_t>> socket_write(SocketHandle &sock,
                                          std::span<char const> buf) {
     co_return static_cast<std::size_t>(co_await expectError(
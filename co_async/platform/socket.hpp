@@ -179,6 +179,14 @@ Task<Expected<SocketHandle>> listener_accept(SocketListener &listener,
 Task<Expected<SocketHandle>> listener_accept(SocketListener &listener,
                                              SocketAddress &peerAddr,
                                              CancelToken cancel);
+// one multishot accept SQE for all incoming connections, falls back to
+// listener_accept in a loop on kernels without it
+Task<GeneratorResult<SocketHandle, Expected<>>>
+listener_accept_multishot(SocketListener &listener);
+// yields indices into the registered file table (which must have free slots)
+// instead of file descriptors, only usable from the ring of this thread
+Task<GeneratorResult<unsigned int, Expected<>>>
+listener_accept_multishot_direct(SocketListener &listener);
 Task<Expected<std::size_t>> socket_write(SocketHandle &sock,
                                          std::span<char const> buf);
 Task<Expected<std::size_t>> socket_write_zc(SocketHandle &sock,
@@ -169,53 +169,122 @@ private:
         fixViolation(node);
     }
 
+    void transplant(RbNode *node, RbNode *child) noexcept {
+        if (node->rbParent == nullptr) {
+            root = child;
+        } else if (node == node->rbParent->rbLeft) {
+            node->rbParent->rbLeft = child;
+        } else {
+            node->rbParent->rbRight = child;
+        }
+        if (child != nullptr) {
+            child->rbParent = node->rbParent;
+        }
+    }
+
+    static bool isBlack(RbNode *node) noexcept {
+        return node == nullptr || node->rbColor == BLACK;
+    }
+
+    // node may be null, so its parent is passed separately
+    void fixErase(RbNode *node, RbNode *parent) noexcept {
+        while (node != root && isBlack(node)) {
+            if (node == parent->rbLeft) {
+                RbNode *sibling = parent->rbRight;
+                if (sibling->rbColor == RED) {
+                    sibling->rbColor = BLACK;
+                    parent->rbColor = RED;
+                    rotateLeft(parent);
+                    sibling = parent->rbRight;
+                }
+                if (isBlack(sibling->rbLeft) && isBlack(sibling->rbRight)) {
+                    sibling->rbColor = RED;
+                    node = parent;
+                    parent = node->rbParent;
+                } else {
+                    if (isBlack(sibling->rbRight)) {
+                        sibling->rbLeft->rbColor = BLACK;
+                        sibling->rbColor = RED;
+                        rotateRight(sibling);
+                        sibling = parent->rbRight;
+                    }
+                    sibling->rbColor = parent->rbColor;
+                    parent->rbColor = BLACK;
+                    sibling->rbRight->rbColor = BLACK;
+                    rotateLeft(parent);
+                    node = root;
+                }
+            } else {
+                RbNode *sibling = parent->rbLeft;
+                if (sibling->rbColor == RED) {
+                    sibling->rbColor = BLACK;
+                    parent->rbColor = RED;
+                    rotateRight(parent);
+                    sibling = parent->rbLeft;
+                }
+                if (isBlack(sibling->rbLeft) && isBlack(sibling->rbRight)) {
+                    sibling->rbColor = RED;
+                    node = parent;
+                    parent = node->rbParent;
+                } else {
+                    if (isBlack(sibling->rbLeft)) {
+                        sibling->rbRight->rbColor = BLACK;
+                        sibling->rbColor = RED;
+                        rotateLeft(sibling);
+                        sibling = parent->rbLeft;
+                    }
+                    sibling->rbColor = parent->rbColor;
+                    parent->rbColor = BLACK;
+                    sibling->rbLeft->rbColor = BLACK;
+                    rotateRight(parent);
+                    node = root;
+                }
+            }
+        }
+        if (node != nullptr) {
+            node->rbColor = BLACK;
+        }
+    }
+
     void doErase(RbNode *current) noexcept {
         current->rbTree = nullptr;
-        RbNode *node = nullptr;
-        RbNode *child = nullptr;
-        RbColor color = RED;
-        if (current->rbLeft != nullptr && current->rbRight != nullptr) {
-            RbNode *replace = current;
-            replace = replace->rbRight;
+        RbNode *child;
+        RbNode *parent;
+        RbColor color = current->rbColor;
+        if (current->rbLeft == nullptr) {
+            child = current->rbRight;
+            parent = current->rbParent;
+            transplant(current, child);
+        } else if (current->rbRight == nullptr) {
+            child = current->rbLeft;
+            parent = current->rbParent;
+            transplant(current, child);
+        } else {
+            // splice out the successor, then put it where current was
+            RbNode *replace = current->rbRight;
             while (replace->rbLeft != nullptr) {
                 replace = replace->rbLeft;
             }
-            if (current != replace->rbParent) {
-                current->rbParent->rbLeft = replace->rbRight;
-                replace->rbRight = current->rbRight;
-                current->rbRight->rbParent = replace;
+            color = replace->rbColor;
+            child = replace->rbRight;
+            if (replace->rbParent == current) {
+                parent = replace;
             } else {
-                replace->rbParent = current;
-            }
-            if (current == root) {
-                root = replace;
-            } else if (current->rbParent->rbLeft == current) {
-                current->rbParent->rbLeft = replace;
-            } else {
-                current->rbParent->rbRight = replace;
+                parent = replace->rbParent;
+                transplant(replace, child);
+                replace->rbRight = current->rbRight;
+                replace->rbRight->rbParent = replace;
             }
+            transplant(current, replace);
             replace->rbLeft = current->rbLeft;
-            current->rbLeft->rbParent = replace;
-            node = replace;
-            color = node->rbColor;
-            child = node->rbRight;
-        } else {
-            node = current;
-            color = node->rbColor;
-            child = (node->rbLeft != nullptr) ? node->rbLeft : node->rbRight;
-        }
-        if (child != nullptr) {
-            child->rbParent = node->rbParent;
-        }
-        if (node == root) {
-            root = child;
-        } else if (node->rbParent->rbLeft == node) {
-            node->rbParent->rbLeft = child;
-        } else {
-            node->rbParent->rbRight = child;
+            replace->rbLeft->rbParent = replace;
+            replace->rbColor = current->rbColor;
         }
-        if (color == BLACK && root) {
-            fixViolation(child ? child : node->rbParent);
+        current->rbLeft = nullptr;
+        current->rbRight = nullptr;
+        current->rbParent = nullptr;
+        if (color == BLACK && root != nullptr) {
+            fixErase(child, parent);
         }
     }
 
@@ -0,0 +1,115 @@
+#pragma once
+#include <co_async/std.hpp>
+#include <co_async/utils/cacheline.hpp>
+
+namespace co_async {
+// Chase-Lev deque: owner thread push and pop at bottom, others steal at top
+template <class T>
+struct WorkStealingDeque {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    explicit WorkStealingDeque(std::size_t capacity = 256) {
+        auto array = std::make_unique<Array>(std::bit_ceil(capacity));
+        mArray.store(array.get(), std::memory_order_relaxed);
+        mArrays.push_back(std::move(array));
+    }
+
+    WorkStealingDeque(WorkStealingDeque &&) = delete;
+
+    /* owner only */ void push(T value) {
+        auto b = mBottom.load(std::memory_order_relaxed);
+        auto t = mTop.load(std::memory_order_acquire);
+        auto *array = mArray.load(std::memory_order_relaxed);
+        if (b - t > static_cast<std::int64_t>(array->mMask)) [[unlikely]] {
+            array = grow(array, b, t);
+        }
+        array->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /* owner only */ [[nodiscard]] std::optional<T> pop() {
+        auto b = mBottom.load(std::memory_order_relaxed) - 1;
+        auto *array = mArray.load(std::memory_order_relaxed);
+        mBottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = mTop.load(std::memory_order_relaxed);
+        if (t > b) {
+            mBottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        T value = array->get(b);
+        if (t == b) {
+            // last element, race against thieves
+            bool won = mTop.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst,
+                std::memory_order_relaxed);
+            mBottom.store(b + 1, std::memory_order_relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+
+    /* MT-safe */ [[nodiscard]] std::optional<T> steal() {
+        auto t = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = mBottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return std::nullopt;
+        }
+        auto *array = mArray.load(std::memory_order_acquire);
+        T value = array->get(t);
+        if (!mTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    /* MT-safe */ bool empty() const noexcept {
+        return mTop.load(std::memory_order_relaxed) >=
+               mBottom.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Array {
+        std::size_t mMask;
+        std::unique_ptr<std::atomic<T>[]> mData;
+
+        explicit Array(std::size_t size)
+            : mMask(size - 1),
+              mData(std::make_unique<std::atomic<T>[]>(size)) {}
+
+        T get(std::int64_t i) const noexcept {
+            return mData[static_cast<std::size_t>(i) & mMask].load(
+                std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T value) noexcept {
+            mData[static_cast<std::size_t>(i) & mMask].store(
+                value, std::memory_order_relaxed);
+        }
+    };
+
+    Array *grow(Array *array, std::int64_t b, std::int64_t t) {
+        auto newArray = std::make_unique<Array>((array->mMask + 1) * 2);
+        for (auto i = t; i != b; ++i) {
+            newArray->put(i, array->get(i));
+        }
+        array = newArray.get();
+        mArray.store(array, std::memory_order_release);
+        // thieves may still be reading the old arrays, keep them alive
+        mArrays.push_back(std::move(newArray));
+        return array;
+    }
+
+    alignas(hardware_destructive_interference_size)
+        std::atomic<std::int64_t> mTop{0};
+    alignas(hardware_destructive_interference_size)
+        std::atomic<std::int64_t> mBottom{0};
+    std::atomic<Array *> mArray;
+    std::vector<std::unique_ptr<Array>> mArrays;
+};
+} // namespace co_async
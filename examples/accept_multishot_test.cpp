@@ -0,0 +1,120 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::size_t kNumClients = 64;
+
+std::size_t numFailed = 0;
+
+static void check(bool ok, char const *what) {
+    if (!ok) {
+        std::cerr << "failed: " << what << '\n';
+        ++numFailed;
+    }
+}
+
+static Task<Expected<SocketListener>> bindAnyPort(SocketAddress &addr) {
+    addr = co_await AddressResolver()
+               .host("127.0.0.1:0")
+               .socktype(SOCK_STREAM)
+               .resolve_one();
+    auto listener = co_await co_await listener_bind(addr);
+    addr.trySetPort(get_socket_address(listener).port());
+    co_return listener;
+}
+
+static Task<Expected<>> acceptAll(SocketListener &listener,
+                                  std::size_t &numAccepted) {
+    auto incomes = listener_accept_multishot(listener);
+    while (auto income = co_await co_await incomes) {
+        if (++numAccepted == kNumClients) {
+            // the generator is destroyed with its SQE still armed
+            break;
+        }
+    }
+    co_return {};
+}
+
+static Task<Expected<>> connectOne(SocketAddress addr) {
+    auto sock = co_await co_await socket_connect(addr);
+    co_return {};
+}
+
+static Task<Expected<>> testAccept() {
+    SocketAddress addr;
+    auto listener = co_await co_await bindAnyPort(addr);
+    std::size_t numAccepted = 0;
+    std::vector<Task<Expected<>>> clients;
+    for (std::size_t i = 0; i < kNumClients; ++i) {
+        clients.push_back(connectOne(addr));
+    }
+    co_await co_await when_all(std::move(clients));
+    co_await co_await acceptAll(listener, numAccepted);
+    check(numAccepted == kNumClients, "accept all clients");
+    co_return {};
+}
+
+static Task<Expected<String>> fetch(SocketAddress addr) {
+    auto sock = co_await co_await socket_connect(addr);
+    std::string_view req = "GET / HTTP/1.1\r\nconnection: close\r\n\r\n";
+    co_await co_await socket_write(sock, req);
+    String resp;
+    char buf[1024];
+    // the body is short and last, no need to parse the response
+    while (!resp.ends_with("served")) {
+        auto n = co_await co_await socket_read(sock, buf);
+        if (n == 0) {
+            break;
+        }
+        resp.append(buf, n);
+    }
+    co_return resp;
+}
+
+static Task<Expected<>> testServe() {
+    SocketAddress addr;
+    auto listener = co_await co_await bindAnyPort(addr);
+    HTTPServer server;
+    std::array<std::atomic<std::size_t>, 2> numServed{};
+    server.route("GET", "/", [&](HTTPServer::IO &io) -> Task<Expected<>> {
+        numServed[IOContextMT::this_worker_id()].fetch_add(1);
+        co_await co_await HTTPServerUtils::make_ok_response(io, "served");
+        co_return {};
+    });
+    bool stopped = false;
+    co_spawn(co_bind([&]() -> Task<> {
+        (void)co_await server.serve(listener);
+        stopped = true;
+    }));
+    for (std::size_t i = 0; i < 8; ++i) {
+        auto resp = co_await co_await fetch(addr);
+        check(resp.ends_with("served"), "response body");
+    }
+    // wakes the multishot accept with an error, so that serve returns
+    shutdown(listener.fileNo(), SHUT_RDWR);
+    while (!stopped) {
+        co_await co_sleep(1ms);
+    }
+    check(numServed[0].load() == 4 && numServed[1].load() == 4,
+          "connections spread over workers");
+    co_return {};
+}
+
+int main() {
+    co_main(testAccept());
+    {
+        IOContextMT ctx;
+        IOContextMT::start(2);
+        co_main(testServe());
+        IOContextMT::stop();
+        IOContextMT::join();
+    }
+    if (numFailed != 0) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+    std::cerr << "OK\n";
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::size_t kNumWorkers = 4;
+static constexpr std::size_t kNumJobs = 1000;
+
+std::atomic<std::size_t> numDone{0};
+std::atomic<std::size_t> numWrongWorker{0};
+
+static Task<> child() {
+    numDone.fetch_add(1);
+    co_return;
+}
+
+static Task<> job(std::size_t worker) {
+#if !CO_ASYNC_STEAL // otherwise may be stolen by others
+    if (IOContextMT::this_worker_id() != worker) {
+        numWrongWorker.fetch_add(1);
+    }
+#endif
+    co_await co_sleep(1ms);
+    // same-thread spawn must also get a chance to run
+    IOContext::instance->spawn(child());
+    numDone.fetch_add(1);
+}
+
+int main() {
+    IOContextMT ctx;
+    IOContextMT::start(kNumWorkers);
+    // spawn from a foreign thread, round robin across workers
+    std::thread([] {
+        for (std::size_t i = 0; i < kNumJobs; ++i) {
+            IOContextMT::spawn(job(i % kNumWorkers), i % kNumWorkers);
+        }
+    }).join();
+    for (std::size_t i = 0; i < 500 && numDone.load() != kNumJobs * 2; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    IOContextMT::stop();
+    IOContextMT::join();
+    debug(), numDone.load(), numWrongWorker.load();
+    if (numDone.load() != kNumJobs * 2 || numWrongWorker.load() != 0) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+    std::cerr << "OK\n";
+    return 0;
+}
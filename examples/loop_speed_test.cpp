@@ -0,0 +1,51 @@
+#include <co_async/std.hpp>
+#include <co_async/co_async.hpp>
+
+using namespace co_async;
+using namespace std::literals;
+
+static Task<> nop_loop(std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+        co_await fs_nop();
+    }
+}
+
+// each fs_nop completion is resumed from one event loop turn, with more
+// coroutines in flight, more completions are dispatched per turn
+static Task<> bench(std::size_t concurrency, std::size_t total) {
+    std::vector<Task<>> tasks;
+    for (std::size_t i = 0; i < concurrency; i++) {
+        tasks.push_back(nop_loop(total / concurrency));
+    }
+    auto stats0 = PlatformIOContext::instance->stats();
+    auto t0 = std::chrono::steady_clock::now();
+    co_await when_all(tasks);
+    auto dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0);
+    auto stats = PlatformIOContext::instance->stats();
+    auto numSubmits = stats.numSubmits - stats0.numSubmits;
+    auto numSqes = stats.numSqesSubmitted - stats0.numSqesSubmitted;
+    std::cout << "concurrency " << concurrency << ": "
+              << static_cast<std::size_t>(total / dt.count())
+              << " completions/s, "
+              << stats.numEnters - stats0.numEnters << " enters, "
+              << (numSubmits ? numSqes / numSubmits : 0) << " SQEs per submit, "
+              << stats.numEntersSkipped - stats0.numEntersSkipped
+              << " enters skipped\n";
+}
+
+static Task<> amain() {
+    constexpr std::size_t n = 1000000;
+    co_await bench(1, n);
+    co_await bench(16, n);
+    co_await bench(256, n);
+}
+
+int main() {
+    for (std::size_t submitBatch: {0, 64}) {
+        std::cout << "submitBatch " << submitBatch << ":\n";
+        IOContext ctx({.submitBatch = submitBatch});
+        co_spawn(amain());
+        ctx.run();
+    }
+    return 0;
+}
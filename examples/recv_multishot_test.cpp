@@ -0,0 +1,167 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::size_t kNumClients = 1;
+static constexpr std::size_t kNumLines = 200;
+
+std::size_t numFailed = 0;
+
+static void check(bool ok, char const *what) {
+    if (!ok) {
+        std::cerr << "failed: " << what << '\n';
+        ++numFailed;
+    }
+}
+
+static std::string makeLine(std::size_t client, std::size_t i) {
+    // longer than a provided buffer now and then
+    return std::to_string(client) + ':' + std::string(i % 150, 'x') + '\n';
+}
+
+static Task<Expected<SocketListener>> bindAnyPort(SocketAddress &addr) {
+    addr = co_await AddressResolver()
+               .host("127.0.0.1:0")
+               .socktype(SOCK_STREAM)
+               .resolve_one();
+    auto listener = co_await co_await listener_bind(addr);
+    addr.trySetPort(get_socket_address(listener).port());
+    co_return listener;
+}
+
+static Task<Expected<>> serveOne(SocketHandle handle) {
+    auto sock = make_stream<SocketStream>(std::move(handle), true);
+    std::size_t n = 0;
+    std::size_t client = 0;
+    String line;
+    while (n < kNumLines) {
+        line.clear();
+        if ((co_await sock.getline(line, '\n')).has_error()) {
+            break;
+        }
+        if (n == 0) {
+            client = from_string<std::size_t>(line.substr(0, line.find(':')))
+                         .value();
+        }
+        auto expect = makeLine(client, n);
+        expect.pop_back();
+        std::cerr << "DBG got " << n << ' ' << line.size() << '\n';
+        check(line == expect, "line content");
+        ++n;
+    }
+    check(n == kNumLines, "line count");
+    co_return {};
+}
+
+static Task<Expected<>> sendLines(SocketAddress addr, std::size_t client) {
+    auto sock = co_await co_await socket_connect(addr);
+    std::string all;
+    for (std::size_t i = 0; i < kNumLines; ++i) {
+        all += makeLine(client, i);
+    }
+    // odd sized chunks, so that lines straddle receives
+    for (std::size_t i = 0; i < all.size(); i += 97) {
+        auto chunk = std::string_view(all).substr(i, 97);
+        co_await co_await socket_write(sock, chunk);
+        std::cerr << "DBG sent " << i << '\n';
+        if (i % 970 == 0) {
+            co_await co_sleep(1ms);
+        }
+    }
+    co_return {};
+}
+
+static Task<Expected<>> testLines() {
+    SocketAddress addr;
+    std::cerr << "DBG a\n";
+    auto listener = co_await co_await bindAnyPort(addr);
+    std::cerr << "DBG b\n";
+    std::vector<Task<Expected<>>> tasks;
+    for (std::size_t i = 0; i < kNumClients; ++i) {
+        tasks.push_back(sendLines(addr, i));
+    }
+    for (std::size_t i = 0; i < kNumClients; ++i) {
+        tasks.push_back(co_bind([&]() -> Task<Expected<>> {
+            co_await co_await serveOne(
+                co_await co_await listener_accept(listener));
+            co_return {};
+        }));
+    }
+    co_await co_await when_all(std::move(tasks));
+    co_return {};
+}
+
+static Task<Expected<>> testTimeout() {
+    SocketAddress addr;
+    auto listener = co_await co_await bindAnyPort(addr);
+    auto client = co_await co_await socket_connect(addr);
+    auto sock = make_stream<SocketStream>(
+        co_await co_await listener_accept(listener), true);
+    sock.timeout(10ms);
+    auto ret = co_await sock.getchar();
+    check(ret == std::make_error_code(std::errc::stream_timeout), "timeout");
+    // data arriving after the timeout is still received
+    co_await co_await socket_write(client, "late\n"sv);
+    auto line = co_await co_await sock.getline('\n');
+    check(line == "late", "read after timeout");
+    // the stream is destroyed with the recv still armed
+    co_return {};
+}
+
+static Task<Expected<>> testHTTP() {
+    SocketAddress addr;
+    auto listener = co_await co_await bindAnyPort(addr);
+    HTTPServer server;
+    server.enableRecvMultishot();
+    server.route("GET", "/", [](HTTPServer::IO &io) -> Task<Expected<>> {
+        co_await co_await HTTPServerUtils::make_ok_response(io, "served");
+        co_return {};
+    });
+    auto serverTask = co_bind([&]() -> Task<Expected<>> {
+        co_await co_await server.handle_http(
+            co_await co_await listener_accept(listener));
+        co_return {};
+    });
+    auto clientTask = co_bind([&]() -> Task<Expected<>> {
+        auto sock = co_await co_await socket_connect(addr);
+        for (std::size_t i = 0; i < 4; ++i) {
+            std::string_view req = "GET / HTTP/1.1\r\n\r\n";
+            co_await co_await socket_write(sock, req);
+            String resp;
+            char buf[1024];
+            while (!resp.ends_with("served")) {
+                auto n = co_await co_await socket_read(sock, buf);
+                if (n == 0) {
+                    break;
+                }
+                resp.append(buf, n);
+            }
+            check(resp.starts_with("HTTP/1.1 200"), "keep-alive response");
+        }
+        // closing makes the server see EOF
+        co_return {};
+    });
+    co_await co_await when_all(serverTask, clientTask);
+    co_return {};
+}
+
+int main() {
+    std::cerr << "DBG main\n";
+    // a tiny pool, so that the kernel runs out of buffers
+    IOContext ctx({.uring = {.bufferRingEntries = 8, .bufferRingSize = 64}});
+    std::cerr << "DBG ctx\n";
+    for (auto test: {testLines, testTimeout, testHTTP}) {
+        auto ret = co_catch(test());
+        co_spawn(std::move(ret));
+        ctx.run();
+        std::cerr << "DBG test done\n";
+    }
+    if (numFailed != 0) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+    std::cerr << "OK\n";
+    return 0;
+}
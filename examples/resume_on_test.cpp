@@ -0,0 +1,43 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::size_t kNumHops = 100000;
+
+std::atomic<std::size_t> numWrongWorker{0};
+std::atomic<bool> done{false};
+
+static Task<> pingPong() {
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < kNumHops; ++i) {
+        std::size_t next = (IOContextMT::this_worker_id() + 1) % 2;
+        co_await co_resume_on(IOContextMT::nth_worker(next));
+        if (IOContextMT::this_worker_id() != next) {
+            numWrongWorker.fetch_add(1);
+        }
+    }
+    auto dt = std::chrono::steady_clock::now() - t0;
+    std::cerr << "hops per second: "
+              << static_cast<std::size_t>(kNumHops / std::chrono::duration<double>(dt).count())
+              << '\n';
+    done.store(true);
+    done.notify_one();
+}
+
+int main() {
+    IOContextMT ctx;
+    IOContextMT::start(2);
+    // from a thread without ring, goes through the eventfd fallback
+    IOContextMT::spawn(pingPong(), 0);
+    done.wait(false);
+    IOContextMT::stop();
+    IOContextMT::join();
+    if (numWrongWorker.load() != 0) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+    std::cerr << "OK\n";
+    return 0;
+}
@@ -14,54 +14,7 @@ static Task<Expected<>> amain(std::string serveAt) {
         co_return {};
     });
 
-    struct Worker {
-        std::deque<Task<Expected<>>> q;
-        std::condition_variable cv;
-        std::mutex mtx;
-        std::jthread th;
-
-        void spawn(Task<Expected<>> task) {
-            std::lock_guard lck(mtx);
-            q.push_back(std::move(task));
-            cv.notify_all();
-        }
-
-        void start(std::size_t i) {
-            th = std::jthread([this, i] (std::stop_token stop) {
-                IOContext ctx;
-                PlatformIOContext::schedSetThreadAffinity(i);
-                while (!stop.stop_requested()) [[likely]] {
-                    while (ctx.runOnce()) {
-                        std::lock_guard lck(mtx);
-                        if (!q.empty())
-                            break;
-                    }
-                    std::unique_lock lck(mtx);
-                    cv.wait(lck, [this] { return !q.empty(); });
-                    auto task = std::move(q.front());
-                    q.pop_front();
-                    lck.unlock();
-                    co_spawn(std::move(task));
-                }
-            });
-        }
-    };
-    std::vector<Worker> workers(std::thread::hardware_concurrency());
-
-    for (std::size_t i = 0; i < workers.size(); ++i) {
-        workers[i].start(i);
-    }
-
-    std::size_t i = 0;
-    while (true) {
-        if (auto income = co_await listener_accept(listener)) [[likely]] {
-            workers[i].spawn(server.handle_http(std::move(*income)));
-            ++i;
-            if (i >= workers.size()) {
-                i = 0;
-            }
-        }
-    }
+    co_await co_await server.serve(listener);
     co_return {};
 }
 
@@ -70,6 +23,8 @@ int main(int argc, char **argv) {
     if (argc > 1) {
         serveAt = argv[1];
     }
+    IOContextMT ctx;
+    IOContextMT::start();
     co_main(amain(serveAt));
     return 0;
 }
@@ -0,0 +1,64 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::size_t kNumWorkers = 4;
+static constexpr std::size_t kNumChildren = 64;
+
+std::atomic<std::size_t> numDone{0};
+std::atomic<std::uint32_t> workersUsed{0};
+
+static Task<> heavyChild() {
+    workersUsed.fetch_or(1u << IOContextMT::this_worker_id());
+    // stands for a TLS handshake or zlib work, blocking this worker
+    auto t0 = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - t0 < 5ms)
+        ;
+    co_await co_sleep(1ms);
+    numDone.fetch_add(1);
+}
+
+static Task<> root() {
+    // all children land on the deque of worker 0
+    for (std::size_t i = 0; i < kNumChildren; ++i) {
+        IOContext::instance->spawn(heavyChild());
+    }
+    co_return;
+}
+
+static Task<> respawner() {
+    // keeps the queues busy to exercise shutdown while jobs are in flight
+    IOContext::instance->spawn(respawner());
+    co_return;
+}
+
+int main() {
+    IOContextMT ctx;
+    IOContextMT::start(kNumWorkers);
+    IOContextMT::spawn(root(), 0);
+    for (std::size_t i = 0; i < 500 && numDone.load() != kNumChildren; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    for (std::size_t i = 0; i < kNumWorkers; ++i) {
+        IOContextMT::spawn(respawner(), i);
+    }
+    std::this_thread::sleep_for(50ms);
+    IOContextMT::stop();
+    IOContextMT::join();
+    std::size_t numWorkersUsed = std::popcount(workersUsed.load());
+    debug(), numDone.load(), numWorkersUsed;
+    if (numDone.load() != kNumChildren) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+#if CO_ASYNC_STEAL
+    if (numWorkersUsed < 2) {
+        std::cerr << "FAILED: no job was stolen\n";
+        return 1;
+    }
+#endif
+    std::cerr << "OK\n";
+    return 0;
+}
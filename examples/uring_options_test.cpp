@@ -0,0 +1,79 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::size_t kNumHops = 1000;
+
+std::atomic<bool> done{false};
+std::atomic<std::size_t> numFailed{0};
+
+static void check(bool ok, char const *what) {
+    if (!ok) {
+        std::cerr << "failed: " << what << '\n';
+        numFailed.fetch_add(1);
+    }
+}
+
+static Task<Expected<>> pipeRoundTrip() {
+    auto [reader, writer] = co_await co_await fs_pipe();
+    std::string buf = "hello";
+    co_await co_await fs_write(writer, buf);
+    buf.assign(5, '\0');
+    auto n = co_await co_await fs_read(reader, buf);
+    check(n == 5 && buf == "hello", "pipe round trip");
+    co_return {};
+}
+
+static Task<> amain() {
+    for (std::size_t i = 0; i < 1000; ++i) {
+        co_await fs_nop();
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    co_await co_sleep(2ms);
+    check(std::chrono::steady_clock::now() - t0 >= 2ms, "sleep");
+    check(!(co_await pipeRoundTrip()).has_error(), "pipe");
+}
+
+static Task<> pingPong() {
+    for (std::size_t i = 0; i < kNumHops; ++i) {
+        std::size_t next = (IOContextMT::this_worker_id() + 1) % 2;
+        co_await co_resume_on(IOContextMT::nth_worker(next));
+        check(IOContextMT::this_worker_id() == next, "resume on");
+    }
+    done.store(true);
+    done.notify_one();
+}
+
+static void runWith(char const *name, IOUringOptions uring) {
+    {
+        IOContext ctx({.uring = uring});
+        std::cerr << name << ": setup flags 0x" << std::hex
+                  << PlatformIOContext::instance->setupFlags() << std::dec
+                  << '\n';
+        co_spawn(amain());
+        ctx.run();
+    }
+    done.store(false);
+    IOContextMT ctx;
+    IOContextMT::start(2, {.uring = uring});
+    IOContextMT::spawn(pingPong(), 0);
+    done.wait(false);
+    IOContextMT::stop();
+    IOContextMT::join();
+}
+
+int main() {
+    runWith("default", {});
+    runWith("sqpoll", {.sqPoll = true, .sqPollIdle = 10ms, .sqPollCpu = 0});
+    runWith("coop", {.coopTaskRun = true, .taskRunFlag = true});
+    runWith("single issuer", {.singleIssuer = true, .cqEntries = 4096});
+    runWith("defer", {.taskRunFlag = true, .deferTaskRun = true});
+    if (numFailed.load() != 0) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+    std::cerr << "OK\n";
+    return 0;
+}
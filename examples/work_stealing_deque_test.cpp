@@ -0,0 +1,61 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::size_t kNumItems = 1000000;
+static constexpr std::size_t kNumThieves = 3;
+
+int main() {
+    // tiny initial capacity to go through grow() many times
+    WorkStealingDeque<std::size_t> deque(2);
+    auto seen = std::make_unique<std::atomic<std::uint8_t>[]>(kNumItems);
+    std::atomic<std::size_t> numTaken{0};
+    std::atomic<bool> done{false};
+
+    auto take = [&](std::size_t item) {
+        seen[item].fetch_add(1, std::memory_order_relaxed);
+        numTaken.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    std::vector<std::jthread> thieves;
+    for (std::size_t t = 0; t < kNumThieves; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (auto item = deque.steal()) {
+                    take(*item);
+                }
+            }
+        });
+    }
+
+    for (std::size_t i = 0; i < kNumItems; ++i) {
+        deque.push(i);
+        // owner pops now and then, racing thieves for the last element
+        if (i % 3 == 0) {
+            if (auto item = deque.pop()) {
+                take(*item);
+            }
+        }
+    }
+    while (auto item = deque.pop()) {
+        take(*item);
+    }
+    done.store(true, std::memory_order_release);
+    thieves.clear();
+
+    std::size_t numBad = 0;
+    for (std::size_t i = 0; i < kNumItems; ++i) {
+        if (seen[i].load(std::memory_order_relaxed) != 1) {
+            ++numBad;
+        }
+    }
+    debug(), numTaken.load(), numBad;
+    if (numTaken.load() != kNumItems || numBad != 0) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+    std::cerr << "OK\n";
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+using namespace co_async;
+using namespace std::literals;
+static Task<Expected<int>> quick() { co_await fs_nop(); co_return 1; }
+static Task<Expected<>> amain(int mode) {
+    if (mode == 0) {
+        auto r = co_await when_any(quick(), co_sleep(1s));
+        std::cerr << "a " << r.index() << "\n";
+    } else if (mode == 1) {
+        auto q = quick();
+        auto s = co_sleep(1s);
+        auto r = co_await when_any(q, s);
+        std::cerr << "b " << r.index() << "\n";
+    } else if (mode == 2) {
+        auto r = co_await when_any(quick(), co_forever());
+        std::cerr << "c " << r.index() << "\n";
+    } else {
+        auto r = co_await co_timeout(quick(), 1s);
+        std::cerr << "d " << r.has_value() << "\n";
+    }
+    co_return {};
+}
+int main(int argc, char **argv) { co_main(amain(atoi(argv[1]))); return 0; }